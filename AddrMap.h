@@ -0,0 +1,233 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * AddrMap.h - Definition of a flat map of addresses to entries.
+ ***************************************************************/
+
+#ifndef __ADDRMAP_H__
+#define __ADDRMAP_H__
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "types.h"
+
+/** Map of addresses to entries, held as a flat array sorted by address.
+ *  While a module is being analysed entries are appended and found through
+ *  a hash index, Sort() then orders the array once for rendering. Lookups
+ *  never insert. The map does not own the entries. */
+template <typename T> class CAddrMap
+{
+public:
+	struct Item
+	{
+		u32 addr;
+		T *p;
+	};
+
+	typedef typename std::vector<Item>::const_iterator const_iterator;
+
+	/** Cursor to walk the entries while sweeping up through the addresses */
+	class Cursor
+	{
+		const CAddrMap *m_pMap;
+		size_t m_iPos;
+
+	public:
+		Cursor(const CAddrMap &map)
+			: m_pMap(&map), m_iPos(0)
+		{
+		}
+
+		/** Get the entry at an address, NULL if there is none. Cheap as long
+		 *  as the addresses passed are increasing */
+		T *Seek(u32 addr)
+		{
+			const std::vector<Item> &items = m_pMap->m_items;
+
+			if((m_iPos > 0) && (items[m_iPos-1].addr >= addr))
+			{
+				m_iPos = m_pMap->LowerBound(addr);
+			}
+
+			while((m_iPos < items.size()) && (items[m_iPos].addr < addr))
+			{
+				m_iPos++;
+			}
+
+			if((m_iPos < items.size()) && (items[m_iPos].addr == addr))
+			{
+				return items[m_iPos++].p;
+			}
+
+			return NULL;
+		}
+
+		/** Get the closest entry at or below the last address passed to Seek */
+		T *Nearest() const
+		{
+			return (m_iPos > 0) ? m_pMap->m_items[m_iPos-1].p : NULL;
+		}
+	};
+
+private:
+	typedef std::unordered_map<u32, u32> IndexMap;
+
+	std::vector<Item> m_items;
+	/** Position of each address in m_items while unsorted */
+	IndexMap m_index;
+	bool m_blSorted;
+
+	size_t LowerBound(u32 addr) const
+	{
+		size_t iLow = 0;
+		size_t iHigh = m_items.size();
+
+		while(iLow < iHigh)
+		{
+			size_t iMid = (iLow + iHigh) / 2;
+
+			if(m_items[iMid].addr < addr)
+			{
+				iLow = iMid + 1;
+			}
+			else
+			{
+				iHigh = iMid;
+			}
+		}
+
+		return iLow;
+	}
+
+	static bool CompareItems(const Item &left, const Item &right)
+	{
+		return left.addr < right.addr;
+	}
+
+public:
+	CAddrMap()
+		: m_blSorted(true)
+	{
+	}
+
+	/** Find the entry at an address, NULL if there is none */
+	T *Find(u32 addr) const
+	{
+		if(m_blSorted)
+		{
+			size_t iPos = LowerBound(addr);
+
+			if((iPos < m_items.size()) && (m_items[iPos].addr == addr))
+			{
+				return m_items[iPos].p;
+			}
+		}
+		else
+		{
+			typename IndexMap::const_iterator it = m_index.find(addr);
+
+			if(it != m_index.end())
+			{
+				return m_items[it->second].p;
+			}
+		}
+
+		return NULL;
+	}
+
+	/** Find the closest entry at or below an address, the map must be sorted */
+	T *FindNearest(u32 addr) const
+	{
+		size_t iPos = LowerBound(addr);
+
+		if((iPos < m_items.size()) && (m_items[iPos].addr == addr))
+		{
+			return m_items[iPos].p;
+		}
+
+		return (iPos > 0) ? m_items[iPos-1].p : NULL;
+	}
+
+	/** Set the entry at an address, replacing any existing entry */
+	void Set(u32 addr, T *p)
+	{
+		Item item;
+
+		if(m_blSorted)
+		{
+			size_t iPos = LowerBound(addr);
+
+			if((iPos < m_items.size()) && (m_items[iPos].addr == addr))
+			{
+				m_items[iPos].p = p;
+				return;
+			}
+
+			if(iPos < m_items.size())
+			{
+				/* Out of order, fall back to the index until sorted again */
+				m_blSorted = false;
+				m_index.clear();
+				for(size_t i = 0; i < m_items.size(); i++)
+				{
+					m_index[m_items[i].addr] = i;
+				}
+			}
+		}
+		else
+		{
+			typename IndexMap::iterator it = m_index.find(addr);
+
+			if(it != m_index.end())
+			{
+				m_items[it->second].p = p;
+				return;
+			}
+		}
+
+		if(!m_blSorted)
+		{
+			m_index[addr] = m_items.size();
+		}
+		item.addr = addr;
+		item.p = p;
+		m_items.push_back(item);
+	}
+
+	/** Sort the entries by address, required before using a Cursor or FindNearest */
+	void Sort()
+	{
+		if(!m_blSorted)
+		{
+			std::sort(m_items.begin(), m_items.end(), CompareItems);
+			IndexMap().swap(m_index);
+			m_blSorted = true;
+		}
+	}
+
+	void Clear()
+	{
+		m_items.clear();
+		IndexMap().swap(m_index);
+		m_blSorted = true;
+	}
+
+	size_t Size() const
+	{
+		return m_items.size();
+	}
+
+	const_iterator begin() const
+	{
+		return m_items.begin();
+	}
+
+	const_iterator end() const
+	{
+		return m_items.end();
+	}
+};
+
+#endif
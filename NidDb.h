@@ -0,0 +1,145 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * NidDb.h - Definition of a class to access a precompiled
+ * binary NID database.
+ ***************************************************************/
+
+#ifndef __NIDDB_H__
+#define __NIDDB_H__
+
+#include <stdio.h>
+#include "types.h"
+
+struct LibraryEntry;
+
+#define NIDDB_MAGIC   "PNDB"
+#define NIDDB_VERSION 1
+#define NIDDB_NONE    0xFFFFFFFF
+
+/*
+ * All values are stored little endian. Offsets are from the start of the
+ * file, string values are offsets into the string blob. The library table
+ * is stored in list order (newest first) so the library list can be rebuilt,
+ * the name table is sorted by name and each name owns a range of the index
+ * table which is sorted by NID.
+ */
+
+/** Header of a compiled NID database */
+struct NidDbHeader
+{
+	char magic[4];
+	u32 version;
+	/** Library table, one NidDbLib per library */
+	u32 lib_count;
+	u32 lib_offset;
+	/** NID table, the raw NIDs of each library in order */
+	u32 nid_count;
+	u32 nid_offset;
+	/** Name table, one NidDbName per distinct library name */
+	u32 name_count;
+	u32 name_offset;
+	/** Index table of merged NIDs referenced by the name table */
+	u32 index_count;
+	u32 index_offset;
+	/** Library number of the master NID table and its range in the index */
+	u32 master_lib;
+	u32 master_first;
+	u32 master_count;
+	/** String blob */
+	u32 str_offset;
+	u32 str_size;
+};
+
+/** A single library */
+struct NidDbLib
+{
+	u32 lib_name;
+	u32 prx_name;
+	u32 prx;
+	u32 flags;
+	u32 vcount;
+	u32 fcount;
+	/** Range in the NID table */
+	u32 first_nid;
+	u32 nid_count;
+};
+
+/** A single NID entry */
+struct NidDbNid
+{
+	u32 nid;
+	u32 name;
+};
+
+/** A library name and its merged NIDs */
+struct NidDbName
+{
+	u32 name;
+	/** Library number of the newest library with this name */
+	u32 lib;
+	/** Range in the index table */
+	u32 first;
+	u32 count;
+};
+
+/** Class to access a compiled NID database */
+class CNidDb
+{
+	/** Pointer to the database data */
+	u8 *m_pData;
+	/** Size of the database */
+	u32 m_iSize;
+	/** Indicates the data is mapped rather than allocated */
+	bool m_blMapped;
+
+	const NidDbHeader *m_pHeader;
+	const NidDbLib *m_pLibs;
+	const NidDbNid *m_pNids;
+	const NidDbName *m_pNames;
+	const NidDbNid *m_pIndex;
+	const char *m_pStrings;
+
+	u32 m_iLibCount;
+	u32 m_iNameCount;
+	u32 m_iStrSize;
+
+	void FreeMemory();
+	bool Validate();
+	const char *GetString(u32 iOfs);
+	const NidDbName *FindNameEntry(const char *lib);
+	const char *SearchIndex(u32 iFirst, u32 iCount, u32 nid);
+	void JoinIndex(u32 iFirst, u32 iCount, const u32 *pNids, const u32 *pOrder, u32 iNids, const char **ppNames);
+
+public:
+	CNidDb();
+	~CNidDb();
+	/** Check if a file contains a compiled database */
+	static bool IsNidDb(FILE *fp);
+	/** Map a compiled database */
+	bool Load(const char *szFilename);
+	/** Find a NID in the libraries of the specified name */
+	const char *FindLibName(const char *lib, u32 nid);
+	/** Find a list of NIDs in the libraries of the specified name. pOrder
+	 *  gives the NIDs in ascending order, names already set are kept */
+	void FindLibNames(const char *lib, const u32 *pNids, const u32 *pOrder, u32 iNids, const char **ppNames);
+	/** Find a NID in the master NID table */
+	const char *FindMasterName(u32 nid);
+	/** Find a list of NIDs in the master NID table, as FindLibNames */
+	void FindMasterNames(const u32 *pNids, const u32 *pOrder, u32 iNids, const char **ppNames);
+	/** Indicates if the database contains a master NID table */
+	bool HasMasterNids();
+	/** Find the dependancy file for a library name */
+	const char *FindDependancy(const char *lib);
+	/** Get the number of libraries */
+	u32 GetLibraryCount();
+	/** Create a library entry for a library, returns NULL on error */
+	LibraryEntry *CreateLibrary(u32 iLib);
+	/** Indicates if the library is the master NID table */
+	bool IsMasterLibrary(u32 iLib);
+	/** Write a library list out as a compiled database */
+	static bool Write(FILE *fp, LibraryEntry *pHead, LibraryEntry *pMaster);
+};
+
+#endif
@@ -12,17 +12,29 @@
 #include "types.h"
 #include <tinyxml/tinyxml.h>
 #include "yamltree.h"
+#include "NidDb.h"
+#include "StringPool.h"
+#include <pthread.h>
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <atomic>
 
 #define LIB_NAME_MAX 64
 #define LIB_SYMBOL_NAME_MAX 128
 
-#define FUNCTION_NAME_MAX   128
-#define FUNCTION_ARGS_MAX   128
-#define FUNCTION_RET_MAX    64
-
 struct LibraryEntry;
 
+/** The formats of a NID file */
+enum NidFileType
+{
+	NID_FILE_UNKNOWN = 0,
+	NID_FILE_DB,
+	NID_FILE_XML,
+	NID_FILE_JSON,
+	NID_FILE_YML
+};
+
 /** Structure to hold a single library nid */
 struct LibraryNid
 {
@@ -34,12 +46,12 @@ struct LibraryNid
 	struct LibraryEntry *pParentLib;
 };
 
-/** Structure to hold a single function entry */
+/** Structure to hold a single function entry, the strings are pooled */
 struct FunctionType
 {
-	char name[FUNCTION_NAME_MAX];
-	char args[FUNCTION_ARGS_MAX];
-	char ret[FUNCTION_RET_MAX];
+	const char *name;
+	const char *args;
+	const char *ret;
 };
 
 /** Structure to hold a single library entry */
@@ -68,21 +80,64 @@ struct LibraryEntry
 /** Class to load and manage a list of libraries */
 class CNidMgr
 {
-	typedef std::vector<FunctionType *> FunctionVect;
+	typedef std::unordered_map<const char *, FunctionType, CStringPool::StrHash, CStringPool::StrEqual> FunctionMap;
+	typedef std::unordered_map<u32, LibraryNid *> NidIndex;
+
+	/** Index of a library name, merging every library loaded under that name */
+	struct LibraryIndex
+	{
+		/** The most recently loaded library with this name */
+		LibraryEntry *pLib;
+		/** The NIDs of all libraries with this name, newest library wins */
+		NidIndex nids;
+	};
+
+	typedef std::unordered_map<std::string, LibraryIndex> LibraryIndexMap;
+	typedef std::vector<CNidDb *> NidDbVect;
 
 	/** Head pointer to the list of libraries */
 	LibraryEntry *m_pLibHead;
-	/** Mapping of function names to prototypes */
-	FunctionVect  m_funcMap;
-	/** A buffer to store a pre-generated symbol name so it can be passed to the caller */
-	char m_szCurrName[LIB_SYMBOL_NAME_MAX];
+	/** Hash index of the library list by name */
+	LibraryIndexMap m_libIndex;
+	/** Hash index of the master NID table */
+	NidIndex m_masterIndex;
+	/** Hash index of function names to prototypes, keyed on the pooled name */
+	FunctionMap m_funcMap;
+	/** Storage for the strings of the prototypes */
+	CStringPool m_funcPool;
 	/** Indicator that we have loaded a master NID file */
 	LibraryEntry *m_pMasterNids;
+	/** Compiled databases in load order */
+	NidDbVect m_dbs;
+	/** The newest compiled database containing a master NID table */
+	CNidDb *m_pMasterDb;
+	/** Number of compiled databases already linked into the library list */
+	unsigned int m_iDbsLinked;
+	/** NID and prototype files loaded at the first lookup */
+	std::vector<std::string> m_deferNidFiles;
+	std::vector<std::string> m_deferFuncFiles;
+	/** Cleared while there are deferred files to load */
+	std::atomic<bool> m_blLoaded;
+	/** Set if a deferred NID file could not be loaded */
+	bool m_blLoadFailed;
+	pthread_mutex_t m_loadLock;
+	/** Load the deferred files, once, on the first lookup */
+	void LoadDeferred();
+	bool LoadNIDFile(const char *szFilename);
+	/** Work out the format of an open NID file, printing why if it is unknown */
+	static NidFileType GetNIDFileType(FILE *fp, const char *szFilename);
+	bool LoadFunctionFile(const char *szFilename);
 	/** Generate a name */
 	const char *GenName(const char *lib, u32 nid);
 	/** Search the loaded libs for a symbol */
 	const char *SearchLibs(const char *lib, u32 nid);
+	/** Count a search and name the NID if it was not found */
+	const char *NameNid(const char *lib, u32 nid, const char *pName);
 	void FreeMemory();
+	/** Link a new library into the list and the indexes */
+	void AddLibrary(LibraryEntry *pLib, bool blMasterNids);
+	/** Add the NIDs of a library to an index, earlier duplicates win */
+	static void IndexNids(NidIndex &index, LibraryEntry *pLib);
 	const char* ReadNid(TiXmlElement *pElement, u32 &nid);
 	int CountNids(TiXmlElement *pElement, const char *name);
 	void ProcessLibrary(TiXmlElement *pLibrary, const char *prx_name, const char *prx);
@@ -91,6 +146,7 @@ class CNidMgr
 	bool read_vita_imports_yml(yaml_document *doc);
 
 	bool AddXmlFile(const char *szFilename);
+	bool AddDbFile(const char *szFilename);
 	bool vita_imports_load_json(FILE *text, int verbose);
 	bool vita_imports_load_yml(FILE *text, int verbose);
 
@@ -98,11 +154,33 @@ public:
 	CNidMgr();
 	~CNidMgr();
 	const char *FindLibName(const char *lib, u32 nid);
+	/** Find the names of iNids NIDs of a library in one pass, the names
+	 *  are interned in pool */
+	void FindLibNames(const char *lib, const u32 *pNids, u32 iNids, const char **ppNames, CStringPool &pool);
 	const char *FindDependancy(const char *lib);
 	bool AddNIDFile(const char *szFilename);
+	/** Add a NID file which is only read once a name is looked up, so
+	 *  runs which never look one up do not pay for parsing it. The file is
+	 *  opened and its format checked now, false if either fails */
+	bool DeferNIDFile(const char *szFilename);
+	/** Check if a deferred NID file failed to load, without loading it */
+	bool LoadFailed();
+	/** Load the deferred files now rather than at the first lookup */
+	void EnsureLoaded()
+	{
+		if(!m_blLoaded.load(std::memory_order_acquire))
+		{
+			LoadDeferred();
+		}
+	}
 	LibraryEntry *GetLibraries(void);
+	/** Write the loaded libraries out as a compiled NID database */
+	bool WriteNIDDatabase(FILE *fp);
+	/** Add a file of prototypes, a function in a later file replaces an earlier one */
 	bool AddFunctionFile(const char *szFilename);
-	FunctionType *FindFunctionType(const char *name);
+	/** Add a file of prototypes which is only read at the first lookup */
+	void DeferFunctionFile(const char *szFilename);
+	const FunctionType *FindFunctionType(const char *name);
 };
 
 #endif
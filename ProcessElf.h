@@ -8,8 +8,14 @@
 #ifndef __PROCESS_ELF__
 #define __PROCESS_ELF__
 
+#include <stdio.h>
+#include <vector>
 #include "types.h"
 #include "elftypes.h"
+#include "VirtualMem.h"
+
+/* Largest gap between program headers which is kept in one image region */
+#define IMAGE_GAP_MAX (1024*1024)
 
 class CProcessElf
 {
@@ -20,6 +26,13 @@ protected:
 	u8 *m_pElfBin;
 	u32 m_iBinSize;
 	bool m_blElfLoaded;
+	/* Indicates the elf is a private mapping rather than allocated */
+	bool m_blElfMapped;
+	/* Memory of the binary image in address order, the first is m_pElfBin.
+	 * Segments far apart get separate regions so the gap takes no memory */
+	std::vector<MemRegion> m_binRegions;
+	/* Descriptor of the mapped file while it is being loaded, -1 if none */
+	int m_iElfFd;
 
 	char m_szFilename[MAXPATH];
 
@@ -49,8 +62,15 @@ protected:
 	bool ElfValidateHeader();
 	void ElfDumpHeader();
 	bool BuildBinaryImage();
+	u8* AllocImage(u32 iSize, bool &blMapped);
+	void CopyToImage(const MemRegion &region, u32 iImageOfs, u32 iFileOfs, u32 iSize);
+	bool AddImageRegion(u32 iAddr, u32 iSize);
+	/** Write the binary image from the base address, gaps as zeros */
+	bool WriteImage(FILE *fp);
 	bool BuildFakeSections(unsigned int dwDataBase);
-	u8* LoadFileToMem(const char *szFilename, u32 &lSize);
+	u8* LoadFileToMem(const char *szFilename, u32 &lSize, bool &blMapped);
+	static void FreeFileMem(u8 *pData, u32 iSize, bool blMapped);
+	void CloseFile();
 	bool LoadPrograms();
 	bool FillSection(ElfSection& elfSect, const Elf32_Shdr *pSection);
 	void ElfDumpSections();
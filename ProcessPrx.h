@@ -13,19 +13,56 @@
 #include "prxtypes.h"
 #include "NidMgr.h"
 #include "disasm.h"
+#include "StringPool.h"
+#include "TextWriter.h"
+#include "RelocTable.h"
+#include "RelocPlan.h"
+#include "output.h"
+
+/* An immediate found by a fixup thread, with the relocation that made it */
+struct RelocImm
+{
+	u32 iReloc;
+	ImmEntry *imm;
+};
+
+/** What LoadFromFile builds beyond the module info and the library tables,
+ *  an output mode asks for only what it reads */
+enum PrxLoadParts
+{
+	/* Module info, imports and exports, always loaded */
+	PRX_LOAD_LIBS = 0,
+	/* Immediates of the relocations and the symbols found from them and
+	 * the branches, for disassembly, serializing and aliases */
+	PRX_LOAD_MAPS = 1,
+	/* Names and dependencies of the imports and exports from the NID
+	 * files, without it they get generated names */
+	PRX_LOAD_NAMES = 2,
+	PRX_LOAD_ALL = 0xFFFFFFFF
+};
 
 /* Define ProcessPrx derived from ProcessElf */
 class CProcessPrx : public CProcessElf
 {
+	/* The stage benchmarks drive the loading steps directly */
+	friend class CPrxBench;
+
 	PspModule m_modInfo;
 	CNidMgr   m_defNidMgr;
 	CNidMgr*  m_pCurrNidMgr;
 	CVirtualMem m_vMem;
 	bool m_blPrxLoaded;
-	/* Pointer to the allocated relocation entries, if available */
-	ElfReloc  *m_pElfRelocs;
-	/* Number of relocations */
+	/* Decoded SCE relocations */
+	CRelocTable m_relocs;
+	/* Relocation records for the serializers, built on request */
+	std::vector<ElfReloc> m_elfRelocs;
+	/* Number of relocations, ELF and SCE */
 	int m_iRelocCount;
+	/* Threads used to apply the relocations of a large module */
+	static int m_iRelocThreads;
+	/* Base dependent sites of the relocated image, built on request */
+	CRelocPlan m_plan;
+	bool m_blPlanned;
 	ImmMap m_imms;
 	SymbolMap m_syms;
 	u32 m_dwBase;
@@ -33,30 +70,69 @@ class CProcessPrx : public CProcessElf
 	u32 m_data_size;
 	u32 m_stubBottom;
 	bool m_blXmlDump;
+	/* PrxLoadParts to build when loading */
+	u32 m_iLoadParts;
 	u32 m_iAddr;
+	/* Disassembler state for this module */
+	DisasmContext m_disasm;
+	/* Pool holding the names of the import and export entries */
+	CStringPool m_names;
+	/* Scratch tables of the library being loaded, NIDs then entries */
+	std::vector<u32> m_tableWords;
+	std::vector<const char *> m_tableNames;
 
+	/* The NID manager naming the libraries, the empty default one when
+	 * the names are not loaded */
+	CNidMgr *NameMgr()
+	{
+		return (m_iLoadParts & PRX_LOAD_NAMES) ? m_pCurrNidMgr : &m_defNidMgr;
+	}
+	u8  *FindModuleInfo();
 	bool FillModule(u8 *pData, u32 iAddr);
 	bool CreateFakeSections();
+	void FreeModule();
 	void FreeMemory();
+	bool AllocEntries(PspEntry *&funcs, int f_count, PspEntry *&vars, int v_count);
 	int  LoadSingleImport(PspModuleImport2xx *pImport, u32 addr);
 	bool LoadImports();
 	int  LoadSingleExport(PspModuleExport *pExport, u32 addr);
 	bool LoadExports();
-	int  CountRelocs();
 	int  LoadRelocsTypeA(struct ElfReloc *pRelocs);
-	int  LoadRelocsTypeB(struct ElfReloc *pRelocs);
-	bool LoadRelocs();
+	int  LoadRelocsTypeB(bool blFixup);
+	bool LoadRelocs(bool blFixup);
 	bool BuildMaps();
 	void BuildSymbols();
 	void FreeSymbols();
 	void FreeImms();
+	bool CanFixup();
+	/* A run of the relocations for one fixup thread, in page order */
+	struct FixupJob
+	{
+		CProcessPrx *pPrx;
+		const std::vector<u32> *pOrder;
+		size_t iStart;
+		size_t iEnd;
+		std::vector<RelocImm> imms;
+		/* Output of the worker, passed on by the caller in job order */
+		OutputRecords output;
+		const char *szFile;
+		const char *szPhase;
+	};
+
+	/* Apply a relocation, new immediates go to pImms when set instead of the map */
+	void ApplyReloc(u32 type, u32 iOfsPH, u32 iValPH, u32 offs, u32 addend,
+			std::vector<RelocImm> *pImms = NULL, u32 iReloc = 0);
+	static void FixupWorker(int iJob, void *arg);
+	bool FixupRelocsParallel();
 	void FixupRelocs();
+	bool PlanReloc(size_t i, RelocPlanKind &kind, u32 &dwSite, u32 &dwValue);
+	void BuildRelocPlan();
 	bool ReadString(u32 dwAddr, std::string &str, bool unicode, u32 *dwRet);
-	void DumpStrings(FILE *fp, u32 dwAddr, u32 iSize, unsigned char *pData);
-	void PrintRow(FILE *fp, const u32* row, s32 row_size, u32 addr);
-	void DumpData(FILE *fp, u32 dwAddr, u32 iSize, unsigned char *pData);
-	void Disasm(FILE *fp, u32 dwAddr, u32 iSize, unsigned char *pData, ImmMap &imms);
-	void DisasmXML(FILE *fp, u32 dwAddr, u32 iSize, unsigned char *pData, ImmMap &imms);
+	void DumpStrings(CTextWriter &out, u32 dwAddr, u32 iSize, unsigned char *pData);
+	void PrintRow(CTextWriter &out, const u32* row, s32 row_size, u32 addr);
+	void DumpData(CTextWriter &out, u32 dwAddr, u32 iSize, unsigned char *pData);
+	void Disasm(CTextWriter &out, u32 dwAddr, u32 iSize, unsigned char *pData, ImmMap &imms);
+	void DisasmXML(CTextWriter &out, u32 dwAddr, u32 iSize, unsigned char *pData, ImmMap &imms);
 	void CalcElfSize(size_t &iTotal, size_t &iSectCount, size_t &iStrSize);
 	bool OutputElfHeader(FILE *fp, size_t iSectCount);
 	bool OutputSections(FILE *fp, size_t iElfHeadSize, size_t iSectCount, size_t iStrSize);
@@ -68,14 +144,22 @@ public:
 	virtual bool LoadFromBinFile(const char *szFilename, unsigned int dwDataBase);
 
 	bool PrxToElf(FILE *fp);
+	/* Move a loaded PRX to a new base without decoding it again */
+	bool Rebase(u32 dwBase);
+	const CRelocPlan &GetRelocPlan();
 
 	void SetXmlDump();
+	void SetThumbMode(bool blThumb);
+	/** Set the PrxLoadParts built by the next load, everything by default */
+	void SetLoadParts(u32 iParts);
 	PspModule* GetModuleInfo();
 	ElfReloc* GetRelocs(int &iCount);
 	ElfSymbol* GetSymbols(int &iCount);
 	PspLibImport *GetImports();
 	PspLibExport *GetExports();
 	void SetNidMgr(CNidMgr* nidMgr);
+	/* Set the threads used to apply relocations in every module loaded */
+	static void SetRelocThreads(int iThreads);
 	void Dump(FILE *fp, const char *disopts);
 	void DumpXML(FILE *fp, const char *disopts);
 	SymbolEntry *GetSymbolEntryFromAddr(u32 dwAddr);
@@ -0,0 +1,99 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * RelocPlan.h - Definition of a class holding the base dependent
+ * patch sites of a relocated module.
+ ***************************************************************/
+
+#ifndef __RELOCPLAN_H__
+#define __RELOCPLAN_H__
+
+#include <stdio.h>
+#include <vector>
+#include "types.h"
+#include "VirtualMem.h"
+
+/** How the load address is encoded at a patch site */
+enum RelocPlanKind
+{
+	/* The relocation does not depend on the load address */
+	RELOC_PLAN_NONE = 0,
+	/* A 32 bit word, absolute or relative */
+	RELOC_PLAN_WORD,
+	RELOC_PLAN_PREL31,
+	RELOC_PLAN_THM_CALL,
+	RELOC_PLAN_MOVW,
+	RELOC_PLAN_MOVT,
+	RELOC_PLAN_THM_MOVW,
+	RELOC_PLAN_THM_MOVT,
+	RELOC_PLAN_MAX
+};
+
+/** The sites of a module which change with its load address, sorted by
+ *  address. Each holds the value to encode with the base taken as zero, so
+ *  moving the module is a single pass adding the new base to each value.
+ *  Only the address bits of a site are rewritten, the rest are kept from
+ *  the relocated image. */
+class CRelocPlan
+{
+	std::vector<u32> m_sites;
+	std::vector<u32> m_values;
+	std::vector<u8> m_kinds;
+
+public:
+	void Clear()
+	{
+		m_sites.clear();
+		m_values.clear();
+		m_kinds.clear();
+	}
+
+	void Reserve(size_t iCount)
+	{
+		m_sites.reserve(iCount);
+		m_values.reserve(iCount);
+		m_kinds.reserve(iCount);
+	}
+
+	/** Add a site in relocation order, RELOC_PLAN_NONE marks a site the
+	 *  load address no longer reaches */
+	void Add(u32 dwSite, RelocPlanKind kind, u32 dwValue)
+	{
+		m_sites.push_back(dwSite);
+		m_values.push_back(dwValue);
+		m_kinds.push_back(kind);
+	}
+
+	size_t Size() const
+	{
+		return m_kinds.size();
+	}
+
+	/** Get the image address of the site, without a base */
+	u32 GetSite(size_t i) const
+	{
+		return m_sites[i];
+	}
+
+	RelocPlanKind GetKind(size_t i) const
+	{
+		return (RelocPlanKind) m_kinds[i];
+	}
+
+	/** Get the value encoded at the site for a base of zero */
+	u32 GetValue(size_t i) const
+	{
+		return m_values[i];
+	}
+
+	/** Sort the sites added by address, keeping the last relocation of each */
+	void Finish();
+	/** Rewrite every site for a module loaded at dwBase */
+	void Apply(CVirtualMem &vMem, u32 dwBase) const;
+	/** Write the plan as text, one site a line */
+	bool Write(FILE *fp) const;
+	static const char *GetKindName(RelocPlanKind kind);
+};
+
+#endif
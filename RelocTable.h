@@ -0,0 +1,84 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * RelocTable.h - Definition of a compact table of decoded SCE
+ * relocations.
+ ***************************************************************/
+
+#ifndef __RELOCTABLE_H__
+#define __RELOCTABLE_H__
+
+#include <vector>
+#include "types.h"
+
+/** Decoded relocations held as parallel arrays, ten bytes an entry. The
+ *  program headers of the patched field and of the symbol are 4 bits each
+ *  in the SCE format, so share a byte. */
+class CRelocTable
+{
+	std::vector<u32> m_offsets;
+	std::vector<u32> m_addends;
+	std::vector<u8> m_types;
+	std::vector<u8> m_segs;
+
+public:
+	void Clear()
+	{
+		m_offsets.clear();
+		m_addends.clear();
+		m_types.clear();
+		m_segs.clear();
+	}
+
+	void Reserve(size_t iCount)
+	{
+		m_offsets.reserve(iCount);
+		m_addends.reserve(iCount);
+		m_types.reserve(iCount);
+		m_segs.reserve(iCount);
+	}
+
+	void Add(u32 type, u32 iOfsPH, u32 iValPH, u32 offset, u32 addend)
+	{
+		m_offsets.push_back(offset);
+		m_addends.push_back(addend);
+		m_types.push_back(type);
+		m_segs.push_back((iOfsPH & 0xF) | ((iValPH & 0xF) << 4));
+	}
+
+	size_t Size() const
+	{
+		return m_types.size();
+	}
+
+	/** Get the offset of the patched field from the start of its program header */
+	u32 GetOffset(size_t i) const
+	{
+		return m_offsets[i];
+	}
+
+	u32 GetAddend(size_t i) const
+	{
+		return m_addends[i];
+	}
+
+	u32 GetType(size_t i) const
+	{
+		return m_types[i];
+	}
+
+	/** Get the program header holding the patched field */
+	u32 GetOfsPH(size_t i) const
+	{
+		return m_segs[i] & 0xF;
+	}
+
+	/** Get the program header the symbol is relative to */
+	u32 GetValPH(size_t i) const
+	{
+		return m_segs[i] >> 4;
+	}
+};
+
+#endif
@@ -48,6 +48,8 @@ protected:
 	/* Called with a list of relocs for a single segment */
 	virtual bool SerializeReloc(int count, const ElfReloc *rel)		= 0;
 	virtual bool EndRelocs()											= 0;
+	/** Called to pass any buffered output on to the file */
+	virtual bool Flush()												= 0;
 
 	/** Pointer to the current prx, if the functions need it for what ever reason */
 	CProcessPrx* m_currPrx;
@@ -61,6 +63,9 @@ public:
 	CSerializePrx();
 	virtual ~CSerializePrx();
 	bool Begin();
+	/** Serialize into a fragment of a file begun by another serializer,
+	 *  no file header or footer is written */
+	void BeginFragment();
 	bool SerializePrx(CProcessPrx &prx, u32 iSMask);
 	bool End();
 };
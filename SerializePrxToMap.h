@@ -11,10 +11,11 @@
 
 #include <stdio.h>
 #include "SerializePrx.h"
+#include "TextWriter.h"
 
 class CSerializePrxToMap : public CSerializePrx
 {
-	FILE *m_fpOut;
+	CTextWriter m_out;
 
 	virtual bool StartFile();
 	virtual bool EndFile();
@@ -32,6 +33,7 @@ class CSerializePrxToMap : public CSerializePrx
 	virtual bool StartRelocs();
 	virtual bool SerializeReloc(int count, const ElfReloc *rel);
 	virtual bool EndRelocs();
+	virtual bool Flush();
 
 public:
 	CSerializePrxToMap(FILE *fpOut);
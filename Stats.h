@@ -0,0 +1,141 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * Stats.h - Definition of a class to collect per file timings
+ * and counters.
+ ***************************************************************/
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stdio.h>
+#include <string>
+#include "types.h"
+#include "output.h"
+
+/** Timed phases of processing a file */
+enum StatPhase
+{
+	STAT_READ,
+	STAT_VALIDATE,
+	STAT_PROGRAMS,
+	STAT_SECTIONS,
+	STAT_SYMBOLS,
+	STAT_IMAGE,
+	STAT_RELOCS,
+	STAT_FIXUP,
+	STAT_EXPORTS,
+	STAT_IMPORTS,
+	STAT_MAPS,
+	STAT_DISASM_LOAD,
+	STAT_DUMP,
+	STAT_SERIALIZE,
+	STAT_PHASE_MAX
+};
+
+/** Counted quantities of processing a file */
+enum StatCounter
+{
+	STAT_FILE_BYTES,
+	STAT_IMAGE_BYTES,
+	STAT_DUMP_BYTES,
+	STAT_INSTRUCTIONS,
+	STAT_RELOC_COUNT,
+	STAT_NID_HITS,
+	STAT_NID_MISSES,
+	STAT_SYMBOL_COUNT,
+	STAT_IMM_COUNT,
+	STAT_COUNTER_MAX
+};
+
+/* Relocation types are 8 bits in both the PSP and Vita formats */
+#define STAT_RELOC_TYPES 256
+
+/** Class to collect the statistics of a single file, or the sum of several.
+ *  Each thread has a current set of statistics which the processing code
+ *  adds to, nothing is collected while it is NULL */
+class CStats
+{
+	std::string m_name;
+	u64 m_iStart;
+	u64 m_iWallTime;
+	u64 m_phaseTime[STAT_PHASE_MAX];
+	u32 m_phaseCalls[STAT_PHASE_MAX];
+	u64 m_counters[STAT_COUNTER_MAX];
+	u64 m_relocTypes[STAT_RELOC_TYPES];
+
+	static thread_local CStats *m_pCurrent;
+
+public:
+	CStats(const char *szName);
+	/** Get the current statistics of the calling thread */
+	static CStats *Current()
+	{
+		return m_pCurrent;
+	}
+	/** Set the current statistics of the calling thread, NULL to stop collecting */
+	static void SetCurrent(CStats *pStats);
+	/** Get a monotonic time in nanoseconds */
+	static u64 GetTime();
+	/** Add to a counter of the current statistics */
+	static void Count(StatCounter counter, u64 iValue)
+	{
+		if(m_pCurrent != NULL)
+		{
+			m_pCurrent->m_counters[counter] += iValue;
+		}
+	}
+	/** Count a relocation of a type in the current statistics */
+	static void CountReloc(u32 type)
+	{
+		if(m_pCurrent != NULL)
+		{
+			m_pCurrent->m_relocTypes[type % STAT_RELOC_TYPES]++;
+		}
+	}
+	/** Start and stop the wall clock for the file */
+	void Start();
+	void Stop();
+	void AddTime(StatPhase phase, u64 iTime);
+	/** Add another set of statistics to this one */
+	void Merge(const CStats &stats);
+	/** Write the statistics as a JSON object, szIndent prefixes each line */
+	void WriteJSON(FILE *fp, const char *szIndent) const;
+	/** Write a string as a quoted JSON string */
+	static void WriteJSONString(FILE *fp, const char *str);
+	/** Get the name of a phase as used in the JSON output */
+	static const char *GetPhaseName(StatPhase phase);
+};
+
+/** Scoped timer adding the time spent in a phase to the current statistics.
+ *  It also names the phase in the output written meanwhile */
+class CStatsTimer
+{
+	StatPhase m_phase;
+	CStats *m_pStats;
+	u64 m_iStart;
+	const char *m_szPrevPhase;
+
+public:
+	CStatsTimer(StatPhase phase)
+		: m_phase(phase), m_pStats(CStats::Current()), m_iStart(0)
+	{
+		m_szPrevPhase = COutput::SetPhase(CStats::GetPhaseName(phase));
+		if(m_pStats != NULL)
+		{
+			m_iStart = CStats::GetTime();
+		}
+	}
+
+	~CStatsTimer()
+	{
+		if(m_pStats != NULL)
+		{
+			m_pStats->AddTime(m_phase, CStats::GetTime() - m_iStart);
+		}
+		COutput::SetPhase(m_szPrevPhase);
+	}
+};
+
+#endif
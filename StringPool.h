@@ -0,0 +1,60 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * StringPool.h - Definition of a class to hold interned
+ * strings.
+ ***************************************************************/
+
+#ifndef __STRINGPOOL_H__
+#define __STRINGPOOL_H__
+
+#include <string.h>
+#include <vector>
+#include <unordered_set>
+#include "types.h"
+
+/* Size of each block of string storage */
+#define STRINGPOOL_BLOCK_SIZE 16384
+
+/** Class to store each distinct string once, returned pointers stay
+ *  valid for the lifetime of the pool */
+class CStringPool
+{
+public:
+	/** Hash and compare functors for containers keyed on C strings */
+	struct StrHash
+	{
+		size_t operator()(const char *str) const;
+	};
+
+	struct StrEqual
+	{
+		bool operator()(const char *left, const char *right) const
+		{
+			return strcmp(left, right) == 0;
+		}
+	};
+
+private:
+	typedef std::unordered_set<const char *, StrHash, StrEqual> StrSet;
+
+	/** Allocated blocks of storage */
+	std::vector<char *> m_blocks;
+	/** Free space in the current block */
+	char *m_pFree;
+	size_t m_iFree;
+	/** Set of all strings in the pool */
+	StrSet m_strings;
+
+	char *Alloc(size_t iSize);
+public:
+	CStringPool();
+	~CStringPool();
+	/** Get the pooled copy of a string, adding it if necessary */
+	const char *Intern(const char *str);
+	/** Free all strings in the pool */
+	void Clear();
+};
+
+#endif
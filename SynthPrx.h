@@ -0,0 +1,127 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * SynthPrx.h - Definition of a class to generate synthetic
+ * Vita style PRX files.
+ ***************************************************************/
+
+#ifndef __SYNTHPRX_H__
+#define __SYNTHPRX_H__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "types.h"
+
+/* Relocations address program headers with 4 bits, the relocation
+ * segment takes one of the 16 */
+#define SYNTH_MAX_SEGMENTS 15
+
+/** Parameters of a generated module */
+struct SynthParams
+{
+	/** Seed for the pseudo random contents, the same seed gives the same file */
+	u32 iSeed;
+	/** Number of functions in the text segment and the size of each in bytes */
+	u32 iFuncs;
+	u32 iFuncSize;
+	/** Exported libraries, with the functions and variables in each */
+	u32 iExportLibs;
+	u32 iExportFuncs;
+	u32 iExportVars;
+	/** Imported libraries, with the functions and variables in each */
+	u32 iImportLibs;
+	u32 iImportFuncs;
+	u32 iImportVars;
+	/** Number of strings in the string pool */
+	u32 iStrings;
+	/** Size of the initialised part of each data segment */
+	u32 iDataSize;
+	/** Number of loadable segments, the text and at least one data segment */
+	u32 iSegments;
+	/** Percentage of relocations written in the long form even when they fit the short one */
+	u32 iLongRelocs;
+};
+
+/** Class to build a synthetic Vita style PRX (ELF type 0xFE04) with Thumb-2
+ *  code, a string pool, export and import tables and a PT_SCE_RELA segment,
+ *  along with a NID file naming everything it exports and imports. The files
+ *  are valid input for CProcessPrx but the code does nothing useful. */
+class CSynthPrx
+{
+	/** A generated library and the NIDs in it */
+	struct SynthLib
+	{
+		std::string name;
+		std::vector<u32> funcs;
+		std::vector<u32> vars;
+	};
+
+	/** A loadable segment, the text is segment 0 */
+	struct SynthSeg
+	{
+		std::vector<u8> data;
+		u32 iAddr;
+		u32 iMemSize;
+	};
+
+	SynthParams m_params;
+	std::vector<SynthSeg> m_segs;
+	/** Encoded relocation segment */
+	std::vector<u8> m_relocs;
+	u32 m_iRelocCount;
+	u32 m_iLongCount;
+	/** Address of the module info, the ELF entry point */
+	u32 m_iModInfo;
+	u32 m_iRand;
+	std::vector<SynthLib> m_exports;
+	std::vector<SynthLib> m_imports;
+
+	u32 Random();
+	static void Put16(std::vector<u8> &seg, u32 iOfs, u32 val);
+	static void Put32(std::vector<u8> &seg, u32 iOfs, u32 val);
+	/** Get the program header of a segment, the relocations sit after the first data segment */
+	static u32 GetPH(u32 iSeg)
+	{
+		return (iSeg < 2) ? iSeg : (iSeg + 1);
+	}
+	/** Add a relocation patching iSeg at iOfs with iAddend from the start of iSymSeg */
+	void AddReloc(u32 type, u32 iSeg, u32 iOfs, u32 iSymSeg, u32 iAddend);
+	/** Add a pointer in iSeg at iOfs to the address iAddr in iSymSeg */
+	void PutPointer(u32 iSeg, u32 iOfs, u32 iSymSeg, u32 iAddr);
+	/** Write a relocated BL to a text address */
+	void PutCall(u32 iOfs, u32 iTarget);
+	/** Write a relocated MOVW/MOVT pair loading an address */
+	void PutMovwMovt(u32 iOfs, u32 iReg, u32 iSymSeg, u32 iAddr);
+	void MakeString(std::string &str);
+	void MakeLibs(std::vector<SynthLib> &libs, const char *szPrefix, u32 iLibs, u32 iFuncs, u32 iVars);
+	void BuildCode(u32 iFuncSize, u32 iStubs, u32 iStubCount, const std::vector<u32> &strings);
+	void BuildData(u32 iSeg, u32 iStart, const std::vector<u32> &strings);
+
+public:
+	CSynthPrx();
+	/** Get the default parameters, a module of a few hundred KB */
+	static void GetDefaults(SynthParams &params);
+	/** Multiply the size of a module, leaving the shape alone */
+	static void Scale(SynthParams &params, u32 iScale);
+	/** Build a module in memory */
+	bool Build(const SynthParams &params);
+	/** Write out the module as an ELF file */
+	bool WriteElf(FILE *fp) const;
+	/** Write out the libraries of the module as a psplibdoc XML file */
+	bool WriteNidXml(FILE *fp) const;
+	u32 GetRelocCount() const
+	{
+		return m_iRelocCount;
+	}
+	/** Get the number of relocations in the long form */
+	u32 GetLongRelocCount() const
+	{
+		return m_iLongCount;
+	}
+	/** Get the total size of the loaded image */
+	u32 GetImageSize() const;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * TextWriter.h - Definition of a buffered text output class.
+ ***************************************************************/
+
+#ifndef __TEXTWRITER_H__
+#define __TEXTWRITER_H__
+
+#include <stdio.h>
+#include <string.h>
+#include "types.h"
+
+/* Size of the output buffer, whole buffers are passed straight to the stream */
+#define TEXTWRITER_BUFFER_SIZE (256*1024)
+
+/* Upper case hex digits for each byte value */
+extern const char g_hexTable[256][2];
+
+/** Write v as 8 upper case hex digits (%08X), returns the end of the text */
+static inline char *FormatHex32(char *p, u32 v)
+{
+	memcpy(p, g_hexTable[v >> 24], 2);
+	memcpy(p + 2, g_hexTable[(v >> 16) & 0xFF], 2);
+	memcpy(p + 4, g_hexTable[(v >> 8) & 0xFF], 2);
+	memcpy(p + 6, g_hexTable[v & 0xFF], 2);
+
+	return p + 8;
+}
+
+/** Write v as 2 upper case hex digits (%02X), returns the end of the text */
+static inline char *FormatHex8(char *p, u8 v)
+{
+	memcpy(p, g_hexTable[v], 2);
+
+	return p + 2;
+}
+
+/** Write a string left justified in a field (%-*s), returns the end of the text */
+static inline char *FormatPad(char *p, const char *str, size_t iWidth)
+{
+	size_t iLen = strlen(str);
+
+	memcpy(p, str, iLen);
+	p += iLen;
+	if(iLen < iWidth)
+	{
+		memset(p, ' ', iWidth - iLen);
+		p += iWidth - iLen;
+	}
+
+	return p;
+}
+
+/** Class to buffer text output in front of a stdio stream. Formatting
+ *  helpers write straight into the buffer, the stream only sees whole
+ *  buffers. The writer must be flushed (or destroyed) before anything
+ *  else writes to the stream. */
+class CTextWriter
+{
+	FILE *m_fp;
+	char *m_pBuf;
+	size_t m_iUsed;
+	bool m_blError;
+
+	void Drain();
+	/** Make room for iSize bytes, returns where to write them */
+	char *Reserve(size_t iSize)
+	{
+		if((TEXTWRITER_BUFFER_SIZE - m_iUsed) < iSize)
+		{
+			Drain();
+		}
+
+		return m_pBuf + m_iUsed;
+	}
+
+public:
+	CTextWriter(FILE *fp);
+	~CTextWriter();
+	/** Write a block of text */
+	void Write(const char *pData, size_t iSize);
+	void Puts(const char *str)
+	{
+		Write(str, strlen(str));
+	}
+	void Putc(char ch)
+	{
+		*Reserve(1) = ch;
+		m_iUsed++;
+	}
+	/** Write a value as %08X */
+	void Hex32(u32 v)
+	{
+		FormatHex32(Reserve(8), v);
+		m_iUsed += 8;
+	}
+	/** Write a value as 0x%08X */
+	void Addr(u32 v)
+	{
+		char *p = Reserve(10);
+
+		p[0] = '0';
+		p[1] = 'x';
+		FormatHex32(p + 2, v);
+		m_iUsed += 10;
+	}
+	/** Write a value as %02X */
+	void Hex8(u8 v)
+	{
+		FormatHex8(Reserve(2), v);
+		m_iUsed += 2;
+	}
+	/** Write a string left justified in a field, as %-*s */
+	void Pad(const char *str, size_t iWidth);
+	/** Formatted output for anything without a helper */
+	void Printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+	/** Pass the buffered text to the stream, returns false if any write failed */
+	bool Flush();
+};
+
+#endif
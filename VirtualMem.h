@@ -9,6 +9,9 @@
 #ifndef __VIRTUALMEM_H__
 #define __VIRTUALMEM_H__
 
+#include <string.h>
+#include <vector>
+#include <atomic>
 #include "types.h"
 
 enum MemEndian
@@ -17,15 +20,167 @@ enum MemEndian
 	MEM_BIG_ENDIAN = 1
 };
 
-class CVirtualMem
+/** Read a value stored in the byte order E, the pointer need not be aligned */
+template<MemEndian E> inline u16 MemReadU16(const u8 *p);
+template<MemEndian E> inline u32 MemReadU32(const u8 *p);
+
+template<> inline u16 MemReadU16<MEM_LITTLE_ENDIAN>(const u8 *p)
+{
+	u16 val;
+
+	memcpy(&val, p, sizeof(val));
+	return LH_LE(val);
+}
+
+template<> inline u16 MemReadU16<MEM_BIG_ENDIAN>(const u8 *p)
+{
+	u16 val;
+
+	memcpy(&val, p, sizeof(val));
+	return LH_BE(val);
+}
+
+template<> inline u32 MemReadU32<MEM_LITTLE_ENDIAN>(const u8 *p)
+{
+	u32 val;
+
+	memcpy(&val, p, sizeof(val));
+	return LW_LE(val);
+}
+
+template<> inline u32 MemReadU32<MEM_BIG_ENDIAN>(const u8 *p)
 {
-	u8 *m_pData;
+	u32 val;
+
+	memcpy(&val, p, sizeof(val));
+	return LW_BE(val);
+}
+
+/** A region of a virtual memory space checked once when it is made, the
+ *  reads inside it are not checked again. Reading outside it is undefined */
+template<MemEndian E> class CMemSpan
+{
+	const u8 *m_pData;
+	u32 m_iAddr;
 	u32 m_iSize;
-	s32 m_iBaseAddr;
+public:
+	CMemSpan()
+		: m_pData(NULL), m_iAddr(0), m_iSize(0)
+	{
+	}
+
+	CMemSpan(const u8 *pData, u32 iAddr, u32 iSize)
+		: m_pData(pData), m_iAddr(iAddr), m_iSize(iSize)
+	{
+	}
+
+	bool IsValid() const
+	{
+		return m_pData != NULL;
+	}
+
+	u32 GetAddr() const
+	{
+		return m_iAddr;
+	}
+
+	u32 GetSize() const
+	{
+		return m_iSize;
+	}
+
+	/** Check a value of iSize bytes at iAddr lies in the span */
+	bool Contains(u32 iAddr, u32 iSize) const
+	{
+		return (m_pData != NULL) && (iAddr >= m_iAddr) && ((iAddr - m_iAddr) <= m_iSize) && (iSize <= (m_iSize - (iAddr - m_iAddr)));
+	}
+
+	const u8 *GetPtr(u32 iAddr) const
+	{
+		return m_pData + (iAddr - m_iAddr);
+	}
+
+	u8 GetU8(u32 iAddr) const
+	{
+		return m_pData[iAddr - m_iAddr];
+	}
+
+	u16 GetU16(u32 iAddr) const
+	{
+		return MemReadU16<E>(m_pData + (iAddr - m_iAddr));
+	}
+
+	u32 GetU32(u32 iAddr) const
+	{
+		return MemReadU32<E>(m_pData + (iAddr - m_iAddr));
+	}
+};
+
+typedef CMemSpan<MEM_LITTLE_ENDIAN> CMemSpanLE;
+
+/** A run of the address space backed by contiguous memory */
+struct MemRegion
+{
+	u32 iAddr;
+	u32 iSize;
+	u8 *pData;
+	/** Set by the owner when the memory is a mapping rather than allocated */
+	bool blMapped;
+};
+
+/** A virtual memory space made of regions in address order, addresses
+ *  between them are not part of it. The last byte of each region is never
+ *  read, as has always been the case for the whole space */
+class CVirtualMem
+{
+	std::vector<MemRegion> m_regions;
 	MemEndian m_endian;
+	/* The region last looked up, most reads fall in the same one */
+	mutable std::atomic<u32> m_iLast;
+
+	static bool InRegion(const MemRegion &region, u32 iAddr, u32 iSize)
+	{
+		return (region.pData != NULL) && (iAddr >= region.iAddr) && ((iAddr + iSize) >= iAddr)
+			&& ((iAddr + iSize) < (region.iAddr + region.iSize));
+	}
+	const MemRegion *FindRegion(u32 iAddr) const;
+
+	/* Get the region holding iSize bytes at iAddr, NULL if they are not all in one */
+	const MemRegion *Lookup(u32 iAddr, u32 iSize) const
+	{
+		const MemRegion *pRegion;
+
+		if(m_regions.empty())
+		{
+			return NULL;
+		}
+
+		pRegion = &m_regions[m_iLast.load(std::memory_order_relaxed)];
+		if(!InRegion(*pRegion, iAddr, iSize))
+		{
+			pRegion = FindRegion(iAddr);
+			if((pRegion == NULL) || (!InRegion(*pRegion, iAddr, iSize)))
+			{
+				return NULL;
+			}
+		}
+
+		return pRegion;
+	}
+
+	u8 *Translate(u32 iAddr, u32 iSize) const
+	{
+		const MemRegion *pRegion = Lookup(iAddr, iSize);
+
+		return (pRegion != NULL) ? pRegion->pData + (iAddr - pRegion->iAddr) : NULL;
+	}
+	void BadAddr(const char *szWhat, u32 iAddr);
 public:
 	CVirtualMem();
 	CVirtualMem(u8* pData, u32 iSize, u32 iBaseAddr, MemEndian endian);
+	CVirtualMem(const std::vector<MemRegion> &regions, MemEndian endian);
+	CVirtualMem(const CVirtualMem &mem);
+	CVirtualMem &operator=(const CVirtualMem &mem);
 	~CVirtualMem();
 
 	u8    GetU8(u32 iAddr);
@@ -35,8 +190,31 @@ public:
 	s16   GetS16(u32 iAddr);
 	s32   GetS32(u32 iAddr);
 	void *GetPtr(u32 iAddr);
+	/** Get the amount of data available from this address in its region */
 	u32   GetSize(u32 iAddr);
 	u32   Copy(void *pDest, u32 iAddr, u32 iSize);
+	/** Read iCount words from iAddr in host order, checking the range once.
+	 *  Words outside the memory read as 0, returns the number read from it */
+	u32   CopyU32(u32 *pDest, u32 iAddr, u32 iCount);
+
+	MemEndian GetEndian() const
+	{
+		return m_endian;
+	}
+
+	/** Get a view of iSize bytes from iAddr in the byte order E, the view is
+	 *  not valid if any of it is outside the memory or the order differs */
+	template<MemEndian E> CMemSpan<E> GetSpan(u32 iAddr, u32 iSize) const
+	{
+		u8 *pData = (E == m_endian) ? Translate(iAddr, iSize) : NULL;
+
+		if(pData != NULL)
+		{
+			return CMemSpan<E>(pData, iAddr, iSize);
+		}
+
+		return CMemSpan<E>();
+	}
 };
 
 #endif
@@ -0,0 +1,64 @@
+/***************************************************************
+ * PRXTool : Utility for PSP executables.
+ * (c) TyRaNiD 2k5
+ *
+ * WorkPool.h - Definition of a work stealing thread pool.
+ ***************************************************************/
+
+#ifndef __WORKPOOL_H__
+#define __WORKPOOL_H__
+
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+/** Function to run a single job */
+typedef void (*WorkFunc)(int iJob, void *arg);
+
+/** Class to run a fixed set of jobs on a pool of threads. Each worker owns
+ *  a queue of jobs and steals from the other queues once its own is empty */
+class CWorkPool
+{
+	struct WorkQueue
+	{
+		pthread_mutex_t lock;
+		std::deque<int> jobs;
+	};
+
+	struct WorkerArg
+	{
+		CWorkPool *pPool;
+		int iWorker;
+	};
+
+	int m_iThreads;
+	std::vector<WorkQueue *> m_queues;
+	std::vector<pthread_t> m_threads;
+	std::vector<WorkerArg> m_args;
+	/** Completion state of each job */
+	std::vector<bool> m_done;
+	pthread_mutex_t m_doneLock;
+	pthread_cond_t m_doneCond;
+	WorkFunc m_fn;
+	void *m_arg;
+	bool m_blRunning;
+
+	bool GetJob(int iWorker, int &iJob);
+	void Worker(int iWorker);
+	static void *WorkerEntry(void *arg);
+
+public:
+	CWorkPool(int iThreads);
+	~CWorkPool();
+	/** Start running the jobs, pOrder lists the jobs in the order they
+	 *  should be started (or NULL for 0..iJobs-1) */
+	bool Start(int iJobs, const int *pOrder, WorkFunc fn, void *arg);
+	/** Wait for a single job to finish */
+	void WaitJob(int iJob);
+	/** Wait for all jobs to finish and stop the workers */
+	void Finish();
+	/** Run a set of jobs to completion */
+	bool Run(int iJobs, const int *pOrder, WorkFunc fn, void *arg);
+};
+
+#endif
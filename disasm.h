@@ -7,10 +7,11 @@
 #ifndef __DISASM_H__
 #define __DISASM_H__
 
-#include <map>
 #include <string>
 #include <vector>
 #include "prxtypes.h"
+#include "StringPool.h"
+#include "AddrMap.h"
 
 enum SymbolType
 {
@@ -36,7 +37,7 @@ struct SymbolEntry
 	std::vector<PspLibImport *> imported;
 };
 
-typedef std::map<unsigned int, SymbolEntry*> SymbolMap;
+typedef CAddrMap<SymbolEntry> SymbolMap;
 
 struct ImmEntry
 {
@@ -46,17 +47,35 @@ struct ImmEntry
 	int text;
 };
 
-typedef std::map<unsigned int, ImmEntry *> ImmMap;
+typedef CAddrMap<ImmEntry> ImmMap;
 
-#include <capstone/capstone.h>
+/* Flags of a decoded instruction */
+#define DISASM_INSN_MOVW 1
+#define DISASM_INSN_MOVT 2
+#define DISASM_INSN_CALL 4
+#define DISASM_INSN_CB   8
 
+/* Compact form of a decoded instruction, holds only what is needed for
+ * analysis and printing */
 struct DisasmEntry
 {
-	cs_insn *insn;
+	/* Interned mnemonic and operand text */
+	const char *mnemonic;
+	const char *op_str;
+	/* Branch target, or the immediate operand of a movw/movt */
+	u32 imm;
+	/* Capstone instruction id */
+	u16 id;
+	/* Size in bytes, 0 if no instruction starts at this address */
+	u8 size;
+	/* Branch type (INSTR_TYPE_*), 0 if not a branch */
+	u8 branch;
+	/* DISASM_INSN_* flags */
+	u8 flags;
+	/* Destination register of a movw/movt */
+	u8 reg;
 };
 
-typedef std::map<unsigned int, DisasmEntry *> DisasmMap;
-
 #define DISASM_OPT_MAX       8
 #define DISASM_OPT_HEXINTS   'x'
 #define DISASM_OPT_MREGS     'r'
@@ -70,32 +89,72 @@ typedef std::map<unsigned int, DisasmEntry *> DisasmMap;
 #define INSTR_TYPE_LOCAL 1
 #define INSTR_TYPE_FUNC  2
 
-void SetThumbMode(bool mode);
+/* Flat table of decoded instructions, one slot per halfword */
+struct DisasmTable
+{
+	u32 base;
+	std::vector<DisasmEntry> entries;
+	CStringPool strings;
+};
+
+/* State of the disassembler for a single module. Each module being analysed
+ * or printed needs its own context, separate contexts can be used at the
+ * same time from different threads. */
+struct DisasmContext
+{
+	/* Printing options */
+	int hexints;
+	int mregs;
+	int symaddr;
+	int macroon;
+	int printreal;
+	int printregs;
+	int regmask;
+	int printswap;
+	int signedhex;
+	int xmloutput;
+	int thumb;
+	/* Symbols used to resolve addresses, may be NULL */
+	SymbolMap *syms;
+	/* Decoded instructions */
+	DisasmTable table;
+	/* Pending movw/movt halves per register */
+	int movw[100];
+	int movt[100];
+	/* Buffer for the last disassembled instruction */
+	char code[1024];
+
+	DisasmContext();
+};
+
+void SetThumbMode(DisasmContext *ctx, bool mode);
 
 /* Enable hexadecimal integers for immediates */
-void disasmSetHexInts(int hexints);
+void disasmSetHexInts(DisasmContext *ctx, int hexints);
 /* Enable mnemonic MIPS registers */
-void disasmSetMRegs(int mregs);
+void disasmSetMRegs(DisasmContext *ctx, int mregs);
 /* Enable resolving of PC to a symbol if available */
-void disasmSetSymAddr(int symaddr);
+void disasmSetSymAddr(DisasmContext *ctx, int symaddr);
 /* Enable instruction macros */
-void disasmSetMacro(int macro);
-void disasmSetPrintReal(int printreal);
-void disasmSetOpts(const char *opts, int set);
+void disasmSetMacro(DisasmContext *ctx, int macro);
+void disasmSetPrintReal(DisasmContext *ctx, int printreal);
+void disasmSetOpts(DisasmContext *ctx, const char *opts, int set);
 const char *disasmGetOpts(void);
-void disasmPrintOpts(void);
-const char *disasmInstruction(unsigned int opcode, unsigned int *PC, unsigned int *realregs, unsigned int *regmask, int nothumb);
-const char *disasmInstructionXML(unsigned int opcode, unsigned int PC);
-
-void disasmSetSymbols(SymbolMap *syms);
-void disasmAddBranchSymbols(unsigned int opcode, unsigned int *PC, SymbolMap &syms);
-SymbolType disasmResolveSymbol(unsigned int PC, char *name, int namelen);
-SymbolEntry* disasmFindSymbol(unsigned int PC);
-int disasmIsBranch(unsigned int opcode, unsigned int PC, unsigned int *dwTarget);
-void disasmSetXmlOutput();
-int disasmAddStringRef(unsigned int opcode, unsigned int base, unsigned int size, unsigned int PC, ImmMap &imms, SymbolMap &syms, int data_addr, u32 data_base, u32 data_base_size);
-void resetMovwMovt();
-
-void loadDisasm(const uint8_t *code, size_t code_size, uint64_t address);
+void disasmPrintOpts(DisasmContext *ctx);
+const char *disasmInstruction(DisasmContext *ctx, unsigned int opcode, unsigned int *PC, unsigned int *realregs, unsigned int *regmask, int nothumb);
+const char *disasmInstructionXML(DisasmContext *ctx, unsigned int opcode, unsigned int PC);
+
+void disasmSetSymbols(DisasmContext *ctx, SymbolMap *syms);
+void disasmAddBranchSymbols(DisasmContext *ctx, unsigned int opcode, unsigned int *PC, SymbolMap &syms);
+SymbolType disasmResolveSymbol(DisasmContext *ctx, unsigned int PC, char *name, int namelen);
+SymbolEntry* disasmFindSymbol(DisasmContext *ctx, unsigned int PC);
+/* Find the closest symbol at or below an address */
+SymbolEntry* disasmFindNearestSymbol(DisasmContext *ctx, unsigned int PC);
+int disasmIsBranch(DisasmContext *ctx, unsigned int opcode, unsigned int *PC, unsigned int *dwTarget);
+void disasmSetXmlOutput(DisasmContext *ctx);
+int disasmAddStringRef(DisasmContext *ctx, unsigned int opcode, unsigned int base, unsigned int size, unsigned int PC, ImmMap &imms, SymbolMap &syms, int data_addr, u32 data_base, u32 data_base_size);
+void resetMovwMovt(DisasmContext *ctx);
+
+void loadDisasm(DisasmContext *ctx, const uint8_t *code, size_t code_size, uint64_t address);
 
 #endif
@@ -8,6 +8,10 @@
 #ifndef __OUTPUT_H__
 #define __OUTPUT_H__
 
+#include <string>
+#include <vector>
+#include "types.h"
+
 enum OutputLevel
 {
 	LEVEL_INFO = 0,
@@ -16,7 +20,20 @@ enum OutputLevel
 	LEVEL_DEBUG = 3
 };
 
-typedef void (*OutputHandler)(OutputLevel level, const char *szDebug);
+/** A single output message with the context it was written in */
+struct OutputRecord
+{
+	OutputLevel level;
+	/** The input file being processed, NULL if none */
+	const char *szFile;
+	/** The phase of processing, NULL if none */
+	const char *szPhase;
+	std::string text;
+};
+
+typedef std::vector<OutputRecord> OutputRecords;
+
+typedef void (*OutputHandler)(const OutputRecord &rec);
 
 class COutput
 {
@@ -27,10 +44,41 @@ class COutput
 	~COutput() {};
 public:
 	static void SetDebug(bool blDebug);
-	static bool GetDebug();
+	static bool GetDebug()
+	{
+#ifdef PRXTOOL_NO_DEBUG
+		return false;
+#else
+		return m_blDebug;
+#endif
+	}
+	/** Check if a level is output before formatting anything for it */
+	static bool IsEnabled(OutputLevel level)
+	{
+		return (level != LEVEL_DEBUG) || (GetDebug());
+	}
 	static void SetOutputHandler(OutputHandler fn);
 	static void Puts(OutputLevel level, const char *str);
 	static void Printf(OutputLevel level, const char *str, ...);
+	/** Capture the output of the calling thread instead of passing it to
+	 *  the handler, NULL to stop capturing */
+	static void SetCapture(OutputRecords *pRecords);
+	static OutputRecords *GetCapture();
+	/** Pass previously captured output on, to the capture of the calling
+	 *  thread if it has one or else to the handler */
+	static void Replay(const OutputRecords &records);
+	/** Set the input file the output of the calling thread is about */
+	static void SetFile(const char *szFile);
+	static const char *GetFile();
+	/** Set the phase of processing of the calling thread, the strings must
+	 *  outlive the output. Returns the previous phase */
+	static const char *SetPhase(const char *szPhase);
+	static const char *GetPhase();
 };
 
+/* Debug output, the arguments are only evaluated when debug output is
+ * enabled. Building with PRXTOOL_NO_DEBUG removes it entirely */
+#define DEBUG_PRINTF(...) do { if(COutput::GetDebug()) COutput::Printf(LEVEL_DEBUG, __VA_ARGS__); } while(0)
+#define DEBUG_PUTS(str) do { if(COutput::GetDebug()) COutput::Puts(LEVEL_DEBUG, str); } while(0)
+
 #endif
@@ -13,7 +13,6 @@
 
 #define PSP_MODULE_MAX_NAME 28
 #define PSP_LIB_MAX_NAME 128
-#define PSP_ENTRY_MAX_NAME 128
 /* Define the maximum number of permitted entries per lib */
 #define PSP_MAX_V_ENTRIES 512
 #define PSP_MAX_F_ENTRIES 4096
@@ -101,8 +100,8 @@ struct PspModuleInfo
 /* Define the loaded prx types */
 struct PspEntry
 {
-	/* Name of the entry */
-	char name[PSP_ENTRY_MAX_NAME];
+	/* Name of the entry, points into a string pool */
+	const char *name;
 	/* Nid of the entry */
 	u32 nid;
 	/* Type of the entry */
@@ -126,16 +125,16 @@ struct PspLibImport
 	u32 addr;
 	/** Copy of the import stub (in native byte order) */
 	PspModuleImport2xx stub;
-	/** List of function entries */
-	PspEntry funcs[PSP_MAX_F_ENTRIES];
+	/** List of function entries, allocated along with the variable entries */
+	PspEntry *funcs;
 	/** Number of function entries */
 	int f_count;
-	/** List of variable entried */
-	PspEntry vars[PSP_MAX_V_ENTRIES];
+	/** List of variable entried, follows the function entries */
+	PspEntry *vars;
 	/** Number of variable entries */
 	int v_count;
-	/** File containing the export */
-	char file[PATH_MAX];
+	/** File containing the export, points into a string pool */
+	const char *file;
 };
 
 /* Holds a linking entry for an export library */
@@ -151,12 +150,12 @@ struct PspLibExport
 	u32 addr;
 	/** Copy of the import stub (in native byte order) */
 	PspModuleExport stub;
-	/** List of function entries */
-	PspEntry funcs[PSP_MAX_F_ENTRIES];
+	/** List of function entries, allocated along with the variable entries */
+	PspEntry *funcs;
 	/** Number of function entries */
 	int f_count;
-	/** List of variable entried */
-	PspEntry vars[PSP_MAX_V_ENTRIES];
+	/** List of variable entried, follows the function entries */
+	PspEntry *vars;
 	/** Number of variable entires */
 	int v_count;
 };
@@ -174,6 +173,10 @@ struct PspModule
 	PspLibExport *exp_head;
 	/** Head of the import list */
 	PspLibImport *imp_head;
+	/** Tail of the export list */
+	PspLibExport *exp_tail;
+	/** Tail of the import list */
+	PspLibImport *imp_tail;
 };
 
 #define SYMFILE_MAGIC "SYMS"